@@ -23,6 +23,8 @@
 #ifndef OBJECT_H
 #define OBJECT_H
 
+#include <stdint.h>
+
 /* hash definitions */
 /**
  * TRUE is the value usually returned from routines to indicate success.
@@ -57,6 +59,80 @@
  */
 #define ONE_SECOND_MS        (1000)                                
 
+/**
+ * Detection method for Object_Detection_Method_Set. Scan the image in raster order, and flood fill each object
+ * from its seed pixel. This is the default.
+ */
+#define OBJECT_DETECTION_METHOD_FLOOD_FILL	(0)
+
+/**
+ * Detection method for Object_Detection_Method_Set. Label runs of pixels row by row using two-pass union-find,
+ * accessing the image sequentially. Produces the same object list as OBJECT_DETECTION_METHOD_FLOOD_FILL.
+ */
+#define OBJECT_DETECTION_METHOD_UNION_FIND	(1)
+
+/**
+ * Pixel storage for Object_Pixel_Storage_Set. Each object pixel is stored as a HighPixel in the object's 
+ * highpixel list, with its value. This is the default.
+ */
+#define OBJECT_PIXEL_STORAGE_HIGHPIXEL		(0)
+
+/**
+ * Pixel storage for Object_Pixel_Storage_Set. Each object's footprint is stored as an array of row spans
+ * in span_list, and pixel values are read back from the image when needed. The highpixel list is empty.
+ */
+#define OBJECT_PIXEL_STORAGE_SPAN		(1)
+
+/**
+ * ROI margin for Object_ROI_Margin_Set. Object_List_Get_ROI only deletes objects within MARGIN pixels of the 
+ * frame edge, as Object_List_Get does. This is the default.
+ */
+#define OBJECT_ROI_MARGIN_FRAME			(0)
+
+/**
+ * ROI margin for Object_ROI_Margin_Set. Object_List_Get_ROI also deletes objects within MARGIN pixels of the
+ * edge of the ROI they were found in, as they may have been cut off by it.
+ */
+#define OBJECT_ROI_MARGIN_ROI			(1)
+
+/**
+ * Pixel type of an image, an array of float. Images passed to Object_List_Get are of this type.
+ */
+#define OBJECT_PIXEL_TYPE_FLOAT			(0)
+
+/**
+ * Pixel type of an image, an array of unsigned 16 bit integers, as passed to Object_List_Get_UInt16.
+ */
+#define OBJECT_PIXEL_TYPE_UINT16		(1)
+
+/**
+ * Pixel type of an image, an array of signed 32 bit integers, as passed to Object_List_Get_Int32.
+ */
+#define OBJECT_PIXEL_TYPE_INT32			(2)
+
+/**
+ * Log method for Object_FWHM_Log_Method_Set. The SExtractor FWHM fit takes the log of each pixel with libm's log().
+ */
+#define OBJECT_FWHM_LOG_LIBM			(0)
+
+/**
+ * Log method for Object_FWHM_Log_Method_Set. The SExtractor FWHM fit takes the log of each pixel with a 
+ * polynomial (vectorised with AVX2 or SSE2), accurate to float precision (relative error about 1e-7). 
+ * This is the default.
+ */
+#define OBJECT_FWHM_LOG_POLYNOMIAL		(1)
+
+/**
+ * Log method for Object_FWHM_Log_Method_Set. The SExtractor FWHM fit takes the log of each pixel by linear
+ * interpolation in a table, with an absolute error below 4e-6 (relative error about 3e-6).
+ */
+#define OBJECT_FWHM_LOG_TABLE			(2)
+
+/**
+ * The maximum number of threads Object_Thread_Count_Set accepts.
+ */
+#define OBJECT_MAX_THREAD_COUNT			(64)
+
 /* structures */
 /**
  * A structure containing high pixels. These are pixels thats make up an object.
@@ -78,6 +154,28 @@ struct HighPixel_Struct
 
 typedef struct HighPixel_Struct HighPixel;
 
+/**
+ * A structure containing a span of pixels on one row that make up part of an object.
+ * <ul>
+ * <li><b>y</b> The row the span lies on.
+ * <li><b>x_start</b> X location of the first pixel in the span.
+ * <li><b>x_end</b> X location of the last pixel in the span (inclusive).
+ * </ul>
+ */
+struct Object_Span_Struct
+{
+	int y;
+	int x_start;
+	int x_end;
+};
+
+typedef struct Object_Span_Struct Object_Span;
+
+/**
+ * Opaque structure holding the slabs of memory a list of objects was allocated from.
+ */
+struct Object_Arena_Struct;
+
 /**
  * A structure containing an object. This object is a collection of contiguous pixels above the threshold.
  * <ul>
@@ -95,7 +193,34 @@ typedef struct HighPixel_Struct HighPixel;
  * <li><b>nextobject</b> A pointer to the next object in the (linked) list.
  * <li><b>highpixel</b> A pointer to a linked list of pixels in the object.
  * <li><b>last_hp</b> A pointer to the end element in the highpixel list.
+ * <li><b>arena</b> The arena the object and its highpixel list were allocated from by Object_List_Get, 
+ *     or NULL if they were allocated individually. All objects in a list share the same arena,
+ *     and it is released by Object_List_Free.
+ * <li><b>span_list</b> With OBJECT_PIXEL_STORAGE_SPAN, an array of the spans of pixels that make up the 
+ *     object, sorted by row and then column, allocated from the arena. Otherwise NULL.
+ * <li><b>span_count</b> The number of spans in span_list.
+ * <li><b>image</b> The image the object was found in. Span pixel values are read back from this, 
+ *     as image[(y*naxis1)+x]-image_median, so it must stay valid while span_list is used.
+ * <li><b>pixel_type</b> The type of the pixels in image, one of OBJECT_PIXEL_TYPE_FLOAT, 
+ *     OBJECT_PIXEL_TYPE_UINT16 and OBJECT_PIXEL_TYPE_INT32.
+ * <li><b>bzero</b> The offset applied to integer pixels read back from image, as bzero+(bscale*pixel).
+ * <li><b>bscale</b> The scale applied to integer pixels read back from image.
+ * <li><b>naxis1</b> The length of the first axis of image.
+ * <li><b>image_median</b> The median pixel value of image.
+ * <li><b>sum_i</b> The sum over the object's pixels of the pixel value above the median (I).
+ * <li><b>sum_xi</b> The sum over the object's pixels of x*I.
+ * <li><b>sum_yi</b> The sum over the object's pixels of y*I.
+ * <li><b>sum_xxi</b> The sum over the object's pixels of x*x*I.
+ * <li><b>sum_yyi</b> The sum over the object's pixels of y*y*I.
+ * <li><b>sum_xyi</b> The sum over the object's pixels of x*y*I.
+ * <li><b>is_oversized</b> Boolean, TRUE if the object had more pixels than the limit set with 
+ *     Object_Max_Pixel_Count_Set. Only the first pixels up to the limit are stored, but the total, peak, 
+ *     centroid and moments are measured from all numpix pixels, and the object is non-stellar.
+ * <li><b>label</b> The provisional label the object was given when it was started, which its pixels are 
+ *     set to in the label map until the map is renumbered with the final objnums (see Object_Label_Map_Set).
  * </ul>
+ * The raw moments sum_i to sum_xyi are accumulated while the object's pixels are found, so the centroid,
+ * ellipticity and ellip_theta are calculated without walking the pixel list again.
  * When using the SExtractor-derived half-flux-radius method of FWHM measures, then both
  * fhhmx and fwhmy will be the same and simly be the object fwhm. Separate values are not
  * returned. The ellipticity value is still valid because A,B are derived internally in the 
@@ -117,6 +242,23 @@ struct Object_Struct
 	struct Object_Struct *nextobject;
 	HighPixel *highpixel;
 	HighPixel *last_hp;
+	struct Object_Arena_Struct *arena;
+	Object_Span *span_list;
+	int span_count;
+	const void *image;
+	int pixel_type;
+	float bzero;
+	float bscale;
+	int naxis1;
+	float image_median;
+	double sum_i;
+	double sum_xi;
+	double sum_yi;
+	double sum_xxi;
+	double sum_yyi;
+	double sum_xyi;
+	int is_oversized;
+	int label;
 };
 
 /**
@@ -124,16 +266,179 @@ struct Object_Struct
  */
 typedef struct Object_Struct Object;
 
+/**
+ * A structure containing a catalogue of objects, stored as columns rather than as a linked list.
+ * Element i of each per-object array describes object number i+1.
+ * <ul>
+ * <li><b>object_count</b> The number of objects in the catalogue.
+ * <li><b>xpos</b> The x position of the centre of each object, weighted by pixel * value in pixel.
+ * <li><b>ypos</b> The y position of the centre of each object, weighted by pixel * value in pixel.
+ * <li><b>total</b> The total number of counts above the median for all pixels in each object.
+ * <li><b>numpix</b> The number of pixels each object covers.
+ * <li><b>peak</b> The number of counts above the median for the brightest pixel in each object.
+ * <li><b>is_stellar</b> Boolean determining whether each object is stellar or not.
+ * <li><b>fwhmx</b> Full width Half Maximum in X in pixels, as for Object_Struct.
+ * <li><b>fwhmy</b> Full width Half Maximum in Y in pixels, as for Object_Struct.
+ * <li><b>ellipticity</b> A simple ellipticity measure. (A-B)/A.
+ * <li><b>ellip_theta</b> Orientation angle of the long axis of the ellipticity.
+ * <li><b>pixel_start</b> The index in the pixel arrays of the first pixel of each object.
+ * <li><b>pixel_end</b> One more than the index in the pixel arrays of the last pixel of each object, so the
+ *     pixels of object i are [pixel_start[i],pixel_end[i]).
+ * <li><b>is_oversized</b> Boolean, TRUE if each object had more pixels than the Object_Max_Pixel_Count_Set 
+ *     limit, as for Object_Struct. Only the stored pixels are in the pixel arrays.
+ * <li><b>pixel_count</b> The total number of pixels in the pixel arrays.
+ * <li><b>pixel_x</b> X location of each pixel.
+ * <li><b>pixel_y</b> Y location of each pixel.
+ * <li><b>pixel_value</b> Value above the image median of each pixel.
+ * </ul>
+ * The per-object arrays share one allocated block, and the pixel arrays another, both freed by
+ * Object_Catalogue_Free.
+ */
+struct Object_Catalogue_Struct
+{
+	int object_count;
+	float *xpos;
+	float *ypos;
+	float *total;
+	int *numpix;
+	float *peak;
+	int *is_stellar;
+	float *fwhmx;
+	float *fwhmy;
+	float *ellipticity;
+	float *ellip_theta;
+	int *pixel_start;
+	int *pixel_end;
+	int *is_oversized;
+	int pixel_count;
+	int *pixel_x;
+	int *pixel_y;
+	float *pixel_value;
+};
+
+/**
+ * Object_Catalogue typedef.
+ */
+typedef struct Object_Catalogue_Struct Object_Catalogue;
+
+/**
+ * A structure describing a rectangular region of interest of an image, for Object_List_Get_ROI.
+ * <ul>
+ * <li><b>x</b> The first column of the region, in full frame pixels.
+ * <li><b>y</b> The first row of the region, in full frame pixels.
+ * <li><b>width</b> The number of columns in the region.
+ * <li><b>height</b> The number of rows in the region.
+ * </ul>
+ */
+struct Object_ROI_Struct
+{
+	int x;
+	int y;
+	int width;
+	int height;
+};
+
+/**
+ * Object_ROI typedef.
+ */
+typedef struct Object_ROI_Struct Object_ROI;
+
+/**
+ * Opaque structure holding the state of a row-streaming detection, from Object_Stream_Begin
+ * to Object_Stream_Finish.
+ */
+struct Object_Stream_Struct;
+
+/**
+ * Object_Stream typedef.
+ */
+typedef struct Object_Stream_Struct Object_Stream;
+
+/**
+ * Opaque structure holding the scratch storage of a detection context, from Object_Context_Create
+ * to Object_Context_Free. A context only saves allocations between frames, it does not make detection
+ * reentrant: the library's configuration, error state and remaining scratch storage are shared, so no two
+ * detections (with the same context, different contexts, or none) may run at the same time.
+ */
+struct Object_Context_Struct;
+
+/**
+ * Object_Context typedef.
+ */
+typedef struct Object_Context_Struct Object_Context;
+
+/**
+ * Opaque structure holding a spatial index over an object list, from Object_Index_Create
+ * to Object_Index_Free.
+ */
+struct Object_Index_Struct;
+
+/**
+ * Object_Index typedef.
+ */
+typedef struct Object_Index_Struct Object_Index;
+
 /* function declarations */
-extern int Object_List_Get(float *image,float image_median,int naxis1,int naxis2,float thresh,int npix,
+extern int Object_List_Get(const float *image,float image_median,int naxis1,int naxis2,float thresh,int npix,
 			   Object **first_object,int *sflag,float *seeing);
+extern int Object_List_Get_Anytime(const float *image,float image_median,int naxis1,int naxis2,float thresh,
+				   int npix,int budget_ms,Object **first_object,int *sflag,float *seeing,
+				   int *truncated);
+extern int Object_List_Get_ROI(const float *image,float image_median,int naxis1,int naxis2,int row_pitch,
+			       const Object_ROI *roi_list,int roi_count,float thresh,int npix,Object **first_object,
+			       int *sflag,float *seeing);
+extern int Object_List_Get_UInt16(const uint16_t *image,float bzero,float bscale,float image_median,int naxis1,
+				  int naxis2,float thresh,int npix,Object **first_object,int *sflag,float *seeing);
+extern int Object_List_Get_Int32(const int32_t *image,float bzero,float bscale,float image_median,int naxis1,
+				 int naxis2,float thresh,int npix,Object **first_object,int *sflag,float *seeing);
+extern int Object_List_Get_Context(Object_Context *context,const float *image,float image_median,int naxis1,
+				   int naxis2,float thresh,int npix,Object **first_object,int *sflag,float *seeing);
 extern int Object_List_Free(Object **list);
+extern int Object_Catalogue_Get(const float *image,float image_median,int naxis1,int naxis2,float thresh,int npix,
+				Object_Catalogue *catalogue,int *sflag,float *seeing);
+extern int Object_Catalogue_From_List(Object *list,Object_Catalogue *catalogue);
+extern int Object_Catalogue_Free(Object_Catalogue *catalogue);
+extern int Object_Stream_Begin(float *image,float image_median,int naxis1,int naxis2,float thresh,
+			       Object_Stream **stream);
+extern int Object_Stream_Push_Rows(Object_Stream *stream,const float *rows,int row_count);
+extern int Object_Stream_Object_List_Get(Object_Stream *stream,Object **first_object,int *object_count);
+extern int Object_Stream_Finish(Object_Stream **stream,int npix,Object **first_object,int *sflag,float *seeing);
+extern int Object_Context_Create(Object_Context **context);
+extern int Object_Context_Free(Object_Context **context);
+extern int Object_Index_Create(Object *list,float cell_size,Object_Index **index);
+extern int Object_Index_Nearest_Get(const Object_Index *index,float x,float y,const Object *exclude_object,
+				    Object **nearest_object,float *distance);
+extern int Object_Index_Radius_Get(const Object_Index *index,float x,float y,float radius,Object **object_list,
+				   int max_count,int *object_count);
+extern int Object_Index_Box_Get(const Object_Index *index,float x_start,float y_start,float x_end,float y_end,
+				Object **object_list,int max_count,int *object_count);
+extern int Object_Index_Free(Object_Index **index);
 extern void Object_Error(void);
 extern void Object_Error_To_String(char *error_string);
 extern int Object_Get_Error_Number(void);
 extern void Object_Warning(void);
 extern int Object_Stellar_Ellipticity_Limit_Set(float limit);
 extern int Object_Saturation_Limit_Set(float saturation);
+extern int Object_FWHM_Pruning_Set(int pruning);
+extern int Object_FWHM_Log_Method_Set(int method);
+extern int Object_Detection_Method_Set(int method);
+extern int Object_Thread_Count_Set(int thread_count);
+extern int Object_Pixel_Storage_Set(int storage);
+extern int Object_Max_Pixel_Count_Set(int max_pixel_count);
+extern int Object_ROI_Margin_Set(int margin);
+extern int Object_Connectivity_Set(int connectivity);
+extern int Object_Instrumentation_Set(int instrumentation);
+extern int Object_Binning_Set(int binning);
+extern int Object_Label_Map_Set(int32_t *label_map);
+extern void Object_Assigned_Bitmap_Free(void);
+extern void Object_Threshold_Mask_Free(void);
+extern void Object_Binned_Image_Free(void);
+extern void Object_Label_Remap_Free(void);
+extern void Object_FWHM_Candidate_List_Free(void);
+extern int Object_Point_Queue_Size_Set(int size);
+extern int Object_Point_Queue_High_Water_Mark_Get(void);
+extern void Object_Point_Queue_Free(void);
+extern void Object_Span_Scratch_Free(void);
 extern void Object_Get_Current_Time_String(char *time_string,int string_length);
 extern void Object_Log_Format(char *sub_system,char *source_filename,char *function,int level,char *category,
 			      char *format,...);
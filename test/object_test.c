@@ -100,6 +100,7 @@
 #include <string.h>
 #include <time.h>
 #include <math.h>
+#include <stdint.h>
 #include "fitsio.h"
 #include "object.h"
 
@@ -112,6 +113,40 @@
  * Number of axes in a valid FITS file.
  */
 #define FITS_GET_DATA_NAXIS (2)
+/**
+ * The maximum number of regions of interest that can be given with -roi.
+ */
+#define OBJECT_TEST_MAX_ROI_COUNT (16)
+/**
+ * The radius, and half width of the box, of the queries made around each object with -index, in pixels.
+ */
+#define OBJECT_TEST_INDEX_RADIUS  (50.0f)
+/**
+ * The number of nanoseconds in one microsecond.
+ */
+#define OBJECT_TEST_ONE_MICROSECOND_NS (1000)
+
+/* ------------------------------------------------------- */
+/* structure declarations */
+/* ------------------------------------------------------- */
+/**
+ * Structure holding what the queries made around one object with -index found.
+ * <ul>
+ * <li><b>nearest_object</b> The nearest other object, or NULL if there is none.
+ * <li><b>nearest_distance</b> The distance to nearest_object, in pixels.
+ * <li><b>radius_count</b> The number of objects within OBJECT_TEST_INDEX_RADIUS, including this one.
+ * <li><b>box_count</b> The number of objects in the box of half width OBJECT_TEST_INDEX_RADIUS, including 
+ *     this one.
+ * </ul>
+ * @see #Index_Test
+ */
+struct Index_Query_Struct
+{
+  Object *nearest_object;
+  float nearest_distance;
+  int radius_count;
+  int box_count;
+};
 
 /* ------------------------------------------------------- */
 /* internal functions declarations */
@@ -121,7 +156,10 @@ static int Parse_Args(int argc,char *argv[]);
 static int Load(void);
 static int Save(void);
 static int Object_Mask_Create(Object *object_list);
+static int Catalogue_Test(Object *object_list);
+static int Index_Test(Object *object_list);
 static int difftimems(struct timespec start_time,struct timespec stop_time);
+static int difftimeus(struct timespec start_time,struct timespec stop_time);
 
 
 /* ------------------------------------------------------- */
@@ -133,7 +171,9 @@ static char rcsid[] = "$Id: object_test.c,v 1.9 2025-02-12 11:39:49 cjm Exp $";
 static char Input_Filename[256] = "";                      /* Filename of file to be processed. */
 static char Output_Filename[256] = "";                     /* Filename of file to be output. */
 static float *Image_Data = NULL;                           /* Data in image array. */
+static uint16_t *UInt16_Image_Data = NULL;                 /* Data as unsigned 16 bit integers, with -uint16 */
 static unsigned short *Object_Mask_Data = NULL;            /* Data created from object pixel list showing extent of each object. */
+static int32_t *Label_Map_Data = NULL;                     /* Label map filled in by detection, for the object mask */
 static int Naxis1;                                         /* Dimensions of data array. */
 static int Naxis2;                                         /* Dimensions of data array. */
 static float Median = 0.0;                                 /* Background median counts */
@@ -145,6 +185,25 @@ static float BGSigma = 10.0;                               /* Default threshold
 static int BGSigma_Set_Flag = FALSE;                       /* Flag to say if BGSigma specified in args */
 static int Log_Level = 0;                                  /* Log level */
 static int verbose = FALSE;                                /* Verbose flag (off by default) */
+static int Detection_Method = OBJECT_DETECTION_METHOD_FLOOD_FILL; /* Object detection engine to use */
+static int Thread_Count = 1;                               /* Number of threads detection uses */
+static int Pixel_Storage = OBJECT_PIXEL_STORAGE_HIGHPIXEL; /* How object pixels are stored */
+static int Stream_Rows = 0;                                /* Rows per push when streaming, 0 to not stream */
+static int Time_Budget = 0;                                /* Detection time budget in ms, 0 for no budget */
+static int Max_Pixel_Count = 0;                            /* Largest object stored, in pixels, 0 for no limit */
+static Object_ROI ROI_List[OBJECT_TEST_MAX_ROI_COUNT];      /* Regions of interest to search, if any */
+static int ROI_Count = 0;                                  /* Number of regions of interest in ROI_List */
+static int ROI_Margin = OBJECT_ROI_MARGIN_FRAME;           /* Where the margin is measured from, with ROIs */
+static int Connectivity = 8;                               /* Which pixels are neighbours, 4 or 8 */
+static int Instrumentation = FALSE;                        /* Whether the detection kernels log each step */
+static int Binning = 1;                                    /* Binning of the coarse pre-pass, 1 for none */
+static int Repeat_Count = 0;                               /* Detections with one context, 0 for no context */
+static int UInt16_Input = FALSE;                           /* Whether to detect on the image as read out, 16 bit */
+static int FWHM_Pruning = FALSE;                           /* Whether to only measure the FWHMs the seeing needs */
+static int FWHM_Log_Method = OBJECT_FWHM_LOG_POLYNOMIAL;    /* How the FWHM fit takes logs */
+static int FWHM_Log_Compare = FALSE;                       /* Whether to report the seeing difference to libm log */
+static int Catalogue_Check = FALSE;                        /* Whether to check a catalogue made from the list */
+static int Index_Check = FALSE;                            /* Whether to check a spatial index over the list */
 static int fltcmp(const void *v1, const void *v2);
 
 /* ------------------------------------------------------- */
@@ -158,14 +217,21 @@ int main(int argc, char *argv[])
   Object *object_list = NULL;
   Object *tmp_object = NULL;
   Object *object = NULL;
+  Object_Stream *stream = NULL;
+  Object_Context *context = NULL;
+  Object *libm_object_list = NULL;
+  Object *libm_object = NULL;
   struct timespec start_time,stop_time;
   int seeing_flag;
+  int truncated = FALSE;
   float seeing,thresh;
+  int libm_seeing_flag;
+  float libm_seeing,fwhm_difference,max_fwhm_difference;
   int obj_count_init;                   /* initial count of all objects */
   int obj_count_size;                   /* objects bigger than size limit (currently 8 pixels) */
   int obj_count_stellar;                /* objects with ellipticity below limit */
   int obj_count_dia;                    /* objects where fwhm < diameter (calculated from size) */
-  int retval;
+  int retval,row,row_count,repeat;
   float BGSD_factor;
   float peak_abs;
   float fwhmx2,fwhmy2;
@@ -247,14 +313,157 @@ int main(int argc, char *argv[])
   */
   if (verbose)
     fprintf(stdout,"object_test: running object detection....\n");
+  if(!Object_Detection_Method_Set(Detection_Method))
+  {
+    Object_Error();
+    return 3;
+  }
+  if(!Object_Thread_Count_Set(Thread_Count))
+  {
+    Object_Error();
+    return 3;
+  }
+  if(!Object_Pixel_Storage_Set(Pixel_Storage))
+  {
+    Object_Error();
+    return 3;
+  }
+  if(!Object_Max_Pixel_Count_Set(Max_Pixel_Count))
+  {
+    Object_Error();
+    return 3;
+  }
+  if(!Object_Connectivity_Set(Connectivity))
+  {
+    Object_Error();
+    return 3;
+  }
+  if(!Object_Instrumentation_Set(Instrumentation))
+  {
+    Object_Error();
+    return 3;
+  }
+  if(!Object_Binning_Set(Binning))
+  {
+    Object_Error();
+    return 3;
+  }
+  if(!Object_FWHM_Pruning_Set(FWHM_Pruning))
+  {
+    Object_Error();
+    return 3;
+  }
+  if(!Object_FWHM_Log_Method_Set(FWHM_Log_Method))
+  {
+    Object_Error();
+    return 3;
+  }
+  /* have detection fill in a label map, to make the object mask from */
+  if(strcmp(Output_Filename,"") != 0)
+  {
+    Label_Map_Data = (int32_t *)malloc(Naxis1*Naxis2*sizeof(int32_t));
+    if(Label_Map_Data == NULL)
+    {
+      fprintf(stderr,"object_test: failed to allocate label map (%d,%d).\n",Naxis1,Naxis2);
+      return 3;
+    }
+    Object_Label_Map_Set(Label_Map_Data);
+  }
   clock_gettime(CLOCK_REALTIME,&start_time);
-  retval = Object_List_Get(Image_Data,Median,Naxis1,Naxis2,thresh,8,&object_list,&seeing_flag,&seeing);
+  if(Stream_Rows > 0)
+  {
+    /* simulate a readout, pushing the loaded image in place a few rows at a time */
+    retval = Object_Stream_Begin(Image_Data,Median,Naxis1,Naxis2,thresh,&stream);
+    for(row=0;(retval == TRUE)&&(row < Naxis2);row+=row_count)
+    {
+      row_count = Stream_Rows;
+      if((row+row_count) > Naxis2)
+	row_count = Naxis2-row;
+      retval = Object_Stream_Push_Rows(stream,Image_Data+(row*Naxis1),row_count);
+    }
+    if(stream != NULL)
+    {
+      if(!Object_Stream_Finish(&stream,8,&object_list,&seeing_flag,&seeing))
+	retval = FALSE;
+    }
+  }
+  else if(ROI_Count > 0)
+  {
+    if(!Object_ROI_Margin_Set(ROI_Margin))
+    {
+      Object_Error();
+      return 3;
+    }
+    retval = Object_List_Get_ROI(Image_Data,Median,Naxis1,Naxis2,Naxis1,ROI_List,ROI_Count,thresh,8,&object_list,
+				 &seeing_flag,&seeing);
+  }
+  else if(Time_Budget > 0)
+    retval = Object_List_Get_Anytime(Image_Data,Median,Naxis1,Naxis2,thresh,8,Time_Budget,&object_list,
+				     &seeing_flag,&seeing,&truncated);
+  else if(Repeat_Count > 0)
+  {
+    /* detect the image repeatedly with one context, as a camera would, and only time the last detection */
+    retval = Object_Context_Create(&context);
+    for(repeat=0;(retval == TRUE)&&(repeat < Repeat_Count);repeat++)
+    {
+      if(object_list != NULL)
+	Object_List_Free(&object_list);
+      clock_gettime(CLOCK_REALTIME,&start_time);
+      retval = Object_List_Get_Context(context,Image_Data,Median,Naxis1,Naxis2,thresh,8,&object_list,
+				       &seeing_flag,&seeing);
+    }
+    if(context != NULL)
+      Object_Context_Free(&context);
+  }
+  else if(UInt16_Input)
+    retval = Object_List_Get_UInt16(UInt16_Image_Data,0.0f,1.0f,Median,Naxis1,Naxis2,thresh,8,&object_list,
+				    &seeing_flag,&seeing);
+  else
+    retval = Object_List_Get(Image_Data,Median,Naxis1,Naxis2,thresh,8,&object_list,&seeing_flag,&seeing);
   clock_gettime(CLOCK_REALTIME,&stop_time);
   if(retval == FALSE){
     Object_Error();
     return 4;
   }
 
+  /* ----------------------------------------- */
+  /* COMPARE THE LOG METHOD WITH THE LIBM LOG  */
+  /* ----------------------------------------- */
+  if(FWHM_Log_Compare)
+  {
+    /* detect again with libm's log, leaving the label map from the first detection for the object mask */
+    Object_Label_Map_Set(NULL);
+    if(!Object_FWHM_Log_Method_Set(OBJECT_FWHM_LOG_LIBM))
+    {
+      Object_Error();
+      return 4;
+    }
+    if(!Object_List_Get(Image_Data,Median,Naxis1,Naxis2,thresh,8,&libm_object_list,&libm_seeing_flag,
+			&libm_seeing))
+    {
+      Object_Error();
+      return 4;
+    }
+    /* both detections find the same objects, so compare them in turn */
+    max_fwhm_difference = 0.0f;
+    tmp_object = object_list;
+    libm_object = libm_object_list;
+    while((tmp_object != NULL)&&(libm_object != NULL)&&(tmp_object->objnum == libm_object->objnum))
+    {
+      fwhm_difference = fabs(tmp_object->fwhmx-libm_object->fwhmx);
+      if(fwhm_difference > max_fwhm_difference)
+	max_fwhm_difference = fwhm_difference;
+      tmp_object = tmp_object->nextobject;
+      libm_object = libm_object->nextobject;
+    }
+    fprintf(stdout,"object_test: With the libm log the seeing was %.4f pixels with seeing_flag = %d, "
+	    "a difference of %.4f pixels (%.4f arcsec).\n",libm_seeing,libm_seeing_flag,seeing-libm_seeing,
+	    (seeing-libm_seeing)*PixelScale);
+    fprintf(stdout,"object_test: The largest difference in an object's FWHM was %.4f pixels.\n",
+	    max_fwhm_difference);
+    Object_List_Free(&libm_object_list);
+  }
+
 
   /* --------------------------------- */
   /* FIND BRIGHTEST OBJECT COORDINATES */
@@ -290,12 +499,28 @@ int main(int argc, char *argv[])
   if (verbose)
   {
     fprintf(stdout,"object_test: The procedure took %d ms.\n",difftimems(start_time,stop_time));
+    if(truncated)
+      fprintf(stdout,"object_test: The time budget ran out, the seeing is from the brightest objects only.\n");
     fprintf(stdout,"object_test: The seeing was %.2f pixels (%.2f arcsec) with seeing_flag = %d (0 is good).\n",
 	    seeing,seeing*PixelScale,seeing_flag);
     fprintf(stdout,"object_test: The brightest object was at %.2f,%.2f with %.2f counts.\n",
 	    brightest_x,brightest_y,brightest_count);
   }
 
+  /* check the catalogue made from the list, while span pixel values can still be read from the image
+     ------------------------------------------------------------------------------------------------ */
+  if(Catalogue_Check){
+    if(!Catalogue_Test(object_list))
+      return 8;
+  }
+
+  /* check the spatial index over the list against a brute force scan
+     ---------------------------------------------------------------- */
+  if(Index_Check){
+    if(!Index_Test(object_list))
+      return 9;
+  }
+
   /*
     ----------
     FREE IMAGE
@@ -303,6 +528,8 @@ int main(int argc, char *argv[])
   */
   if(Image_Data != NULL)
     free(Image_Data);
+  if(UInt16_Image_Data != NULL)
+    free(UInt16_Image_Data);
 
   /* do object mask output?
      ---------------------- */
@@ -313,6 +540,9 @@ int main(int argc, char *argv[])
       return 6;
     if(Object_Mask_Data != NULL)
       free(Object_Mask_Data);
+    Object_Label_Map_Set(NULL);
+    if(Label_Map_Data != NULL)
+      free(Label_Map_Data);
   }
 
   if (verbose)
@@ -475,6 +705,266 @@ static int Parse_Args(int argc,char *argv[])
 				return FALSE;
 			}
 		}
+		/* ----------------------- */
+		/* UNION-FIND DETECTION    */
+		/* ----------------------- */
+		else if (strcmp(argv[i],"-union_find")==0)
+		{
+			Detection_Method = OBJECT_DETECTION_METHOD_UNION_FIND;
+		}
+		/* ------------------ */
+		/* SPAN PIXEL STORAGE */
+		/* ------------------ */
+		else if (strcmp(argv[i],"-spans")==0)
+		{
+			Pixel_Storage = OBJECT_PIXEL_STORAGE_SPAN;
+		}
+		/* --------------------- */
+		/* TIME BUDGET, IN MS    */
+		/* --------------------- */
+		else if (strcmp(argv[i],"-budget")==0)
+		{
+			if((i+1) < argc)
+			{
+				retval = sscanf(argv[i+1],"%d",&Time_Budget);
+				if(retval != 1)
+				{
+					fprintf(stderr,"object_test: Parse_Args: "
+						"budget parameter %s not an integer.\n",argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else 
+			{
+				fprintf(stderr,"object_test: Parse_Args: budget parameter missing.\n");
+				return FALSE;
+			}
+		}
+		/* ------------------------- */
+		/* REGION OF INTEREST        */
+		/* ------------------------- */
+		else if (strcmp(argv[i],"-roi")==0)
+		{
+			if((i+4) < argc)
+			{
+				if(ROI_Count >= OBJECT_TEST_MAX_ROI_COUNT)
+				{
+					fprintf(stderr,"object_test: Parse_Args: too many ROIs (max %d).\n",
+						OBJECT_TEST_MAX_ROI_COUNT);
+					return FALSE;
+				}
+				retval = sscanf(argv[i+1],"%d",&(ROI_List[ROI_Count].x));
+				if(retval == 1)
+					retval = sscanf(argv[i+2],"%d",&(ROI_List[ROI_Count].y));
+				if(retval == 1)
+					retval = sscanf(argv[i+3],"%d",&(ROI_List[ROI_Count].width));
+				if(retval == 1)
+					retval = sscanf(argv[i+4],"%d",&(ROI_List[ROI_Count].height));
+				if(retval != 1)
+				{
+					fprintf(stderr,"object_test: Parse_Args: "
+						"roi parameters %s %s %s %s not integers.\n",argv[i+1],argv[i+2],
+						argv[i+3],argv[i+4]);
+					return FALSE;
+				}
+				ROI_Count++;
+				i += 4;
+			}
+			else 
+			{
+				fprintf(stderr,"object_test: Parse_Args: roi parameters missing.\n");
+				return FALSE;
+			}
+		}
+		/* ------------------------- */
+		/* MARGIN FROM THE ROI EDGE  */
+		/* ------------------------- */
+		else if (strcmp(argv[i],"-roi_margin")==0)
+		{
+			ROI_Margin = OBJECT_ROI_MARGIN_ROI;
+		}
+		/* ------------------------- */
+		/* CONNECTIVITY, 4 OR 8      */
+		/* ------------------------- */
+		else if (strcmp(argv[i],"-connectivity")==0)
+		{
+			if((i+1) < argc)
+			{
+				retval = sscanf(argv[i+1],"%d",&Connectivity);
+				if(retval != 1)
+				{
+					fprintf(stderr,"object_test: Parse_Args: "
+						"connectivity parameter %s not an integer.\n",argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else 
+			{
+				fprintf(stderr,"object_test: Parse_Args: connectivity parameter missing.\n");
+				return FALSE;
+			}
+		}
+		/* ------------------------- */
+		/* COARSE PRE-PASS BINNING   */
+		/* ------------------------- */
+		else if (strcmp(argv[i],"-binning")==0)
+		{
+			if((i+1) < argc)
+			{
+				retval = sscanf(argv[i+1],"%d",&Binning);
+				if(retval != 1)
+				{
+					fprintf(stderr,"object_test: Parse_Args: "
+						"binning parameter %s not an integer.\n",argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else 
+			{
+				fprintf(stderr,"object_test: Parse_Args: binning parameter missing.\n");
+				return FALSE;
+			}
+		}
+		/* ------------------------- */
+		/* REPEAT WITH A CONTEXT    */
+		/* ------------------------- */
+		else if (strcmp(argv[i],"-repeat")==0)
+		{
+			if((i+1) < argc)
+			{
+				retval = sscanf(argv[i+1],"%d",&Repeat_Count);
+				if(retval != 1)
+				{
+					fprintf(stderr,"object_test: Parse_Args: "
+						"repeat parameter %s not an integer.\n",argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else 
+			{
+				fprintf(stderr,"object_test: Parse_Args: repeat parameter missing.\n");
+				return FALSE;
+			}
+		}
+		/* ------------------------- */
+		/* UNSIGNED 16 BIT PIXELS    */
+		/* ------------------------- */
+		else if (strcmp(argv[i],"-uint16")==0)
+		{
+			UInt16_Input = TRUE;
+		}
+		/* ------------------------- */
+		/* FWHM PRUNING              */
+		/* ------------------------- */
+		else if (strcmp(argv[i],"-fwhm_prune")==0)
+		{
+			FWHM_Pruning = TRUE;
+		}
+		/* ------------------------- */
+		/* FWHM LOG METHOD           */
+		/* ------------------------- */
+		else if (strcmp(argv[i],"-fwhm_log")==0)
+		{
+			if((i+1) < argc)
+			{
+				if(strcmp(argv[i+1],"libm")==0)
+					FWHM_Log_Method = OBJECT_FWHM_LOG_LIBM;
+				else if(strcmp(argv[i+1],"polynomial")==0)
+					FWHM_Log_Method = OBJECT_FWHM_LOG_POLYNOMIAL;
+				else if(strcmp(argv[i+1],"table")==0)
+					FWHM_Log_Method = OBJECT_FWHM_LOG_TABLE;
+				else
+				{
+					fprintf(stderr,"object_test: Parse_Args: "
+						"fwhm_log parameter %s not libm, polynomial or table.\n",argv[i+1]);
+					return FALSE;
+				}
+				FWHM_Log_Compare = TRUE;
+				i++;
+			}
+			else 
+			{
+				fprintf(stderr,"object_test: Parse_Args: fwhm_log parameter missing.\n");
+				return FALSE;
+			}
+		}
+		/* ------------------------- */
+		/* INSTRUMENTED KERNELS      */
+		/* ------------------------- */
+		else if (strcmp(argv[i],"-instrument")==0)
+		{
+			Instrumentation = TRUE;
+		}
+		/* ------------------------- */
+		/* MAXIMUM OBJECT PIXELS     */
+		/* ------------------------- */
+		else if (strcmp(argv[i],"-max_pixels")==0)
+		{
+			if((i+1) < argc)
+			{
+				retval = sscanf(argv[i+1],"%d",&Max_Pixel_Count);
+				if(retval != 1)
+				{
+					fprintf(stderr,"object_test: Parse_Args: "
+						"max_pixels parameter %s not an integer.\n",argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else 
+			{
+				fprintf(stderr,"object_test: Parse_Args: max_pixels parameter missing.\n");
+				return FALSE;
+			}
+		}
+		/* ------------------------- */
+		/* STREAMING, ROWS PER PUSH  */
+		/* ------------------------- */
+		else if (strcmp(argv[i],"-stream")==0)
+		{
+			if((i+1) < argc)
+			{
+				retval = sscanf(argv[i+1],"%d",&Stream_Rows);
+				if(retval != 1)
+				{
+					fprintf(stderr,"object_test: Parse_Args: "
+						"stream parameter %s not an integer.\n",argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else 
+			{
+				fprintf(stderr,"object_test: Parse_Args: stream parameter missing.\n");
+				return FALSE;
+			}
+		}
+		/* ------------ */
+		/* THREAD COUNT */
+		/* ------------ */
+		else if (strcmp(argv[i],"-threads")==0)
+		{
+			if((i+1) < argc)
+			{
+				retval = sscanf(argv[i+1],"%d",&Thread_Count);
+				if(retval != 1)
+				{
+					fprintf(stderr,"object_test: Parse_Args: "
+						"threads parameter %s not an integer.\n",argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else 
+			{
+				fprintf(stderr,"object_test: Parse_Args: threads parameter missing.\n");
+				return FALSE;
+			}
+		}
 		/* ------------ */
 		/* VERBOSE FLAG */
 		/* ------------ */
@@ -482,6 +972,20 @@ static int Parse_Args(int argc,char *argv[])
 			verbose = TRUE;
 			fprintf(stdout,"object_test: Parse_Args: verbose ON\n");
 		}
+		/* ------------------------- */
+		/* CATALOGUE CHECK           */
+		/* ------------------------- */
+		else if (strcmp(argv[i],"-catalogue")==0)
+		{
+			Catalogue_Check = TRUE;
+		}
+		/* ------------------------- */
+		/* INDEX CHECK               */
+		/* ------------------------- */
+		else if (strcmp(argv[i],"-index")==0)
+		{
+			Index_Check = TRUE;
+		}
 		/* --------------- */
 		/* INPUT FITS FILE */
 		/* --------------- */
@@ -525,6 +1029,10 @@ static void Help(void)
 	fprintf(stdout,"object_test: Tests the object finding routine in libdprt_object.\n");
 	fprintf(stdout,"object_test [-h[elp]] [-v[erbose]] [-l[og_level] <level>]\n");
 	fprintf(stdout,"\t[-m[edian] <counts>][-t[hreshold] <counts>] [-s[igma] <sigma>]\n");  
+	fprintf(stdout,"\t[-union_find] [-threads <count>] [-spans] [-stream <rows>] [-budget <ms>]\n");
+	fprintf(stdout,"\t[-max_pixels <count>] [-roi <x> <y> <width> <height>]... [-roi_margin]\n");
+	fprintf(stdout,"\t[-connectivity <4|8>] [-instrument] [-binning <1|2|4>] [-repeat <count>]\n");
+	fprintf(stdout,"\t[-uint16] [-fwhm_prune] [-fwhm_log <libm|polynomial|table>] [-catalogue] [-index]\n");
 	fprintf(stdout,"\t<FITS filename>  [-o[utput] <FITS filename>]\n");
 	fprintf(stdout,"-help prints this help message and exits.\n");
 	fprintf(stdout,"-verbose prints progress to stdout (default off).\n");
@@ -533,6 +1041,25 @@ static void Help(void)
 	fprintf(stdout,"-threshold sets the threshold level in counts\n");
 	fprintf(stdout,"-sigma sets the threshold level in sigma (default 10.0)\n");
 	fprintf(stdout,"-output writes an object mask to the specified FITS filename.\n");
+	fprintf(stdout,"-union_find uses the union-find run labelling detection engine rather than flood fill.\n");
+	fprintf(stdout,"-threads sets the number of threads used to detect objects (default 1).\n");
+	fprintf(stdout,"-spans stores object pixels as row spans rather than a list of pixels.\n");
+	fprintf(stdout,"-stream detects objects as the image is pushed in <rows> rows at a time, as during readout.\n");
+	fprintf(stdout,"-budget finds the seeing from the brightest objects found within <ms> milliseconds.\n");
+	fprintf(stdout,"-max_pixels only stores and measures the first <count> pixels of each object.\n");
+	fprintf(stdout,"-roi only searches the given region of interest, and can be repeated.\n");
+	fprintf(stdout,"-roi_margin deletes objects near the edge of their region of interest, as well as the frame.\n");
+	fprintf(stdout,"-connectivity sets whether diagonal pixels are neighbours (8, the default) or not (4).\n");
+	fprintf(stdout,"-instrument logs every step of the detection kernels (needs a high -log_level).\n");
+	fprintf(stdout,"-binning finds candidates in a binned copy of the image, and only searches around them.\n");
+	fprintf(stdout,"-repeat detects the image <count> times reusing one context, and times the last detection.\n");
+	fprintf(stdout,"-uint16 detects objects on the image read as unsigned 16 bit integers, as read out.\n");
+	fprintf(stdout,"-fwhm_prune only measures the FWHM of the largest stellar objects the seeing is found from.\n");
+	fprintf(stdout,"-fwhm_log takes the logs in the FWHM fit with libm, a polynomial (the default) or a table,\n"
+		"\tand reports the difference this makes to the seeing, compared with libm.\n");
+	fprintf(stdout,"-catalogue converts the object list to a column catalogue, and checks it against the list.\n");
+	fprintf(stdout,"-index indexes the object list, checks nearest, radius and box queries against a brute force\n"
+		"\tscan of the list, and reports how long each took.\n");
 	fprintf(stdout,"You must always specify a filename to reduce.\n");
 	fprintf(stdout,"Ideally, pass in a flat-fielded de-biased image.\n");
 	fprintf(stdout,"Use -sigma to let object_test determine the threshold level (the input FITS image requies L1MEDIAN/STDDEV).\n");
@@ -691,6 +1218,25 @@ static int Load(void)
       fprintf(stderr,"object_test:fits_read_img:Failed to read FITS (%d,%d).\n",Naxis1,Naxis2);
       return FALSE;
     }
+  /* read the data again as unsigned 16 bit integers, to detect on it without converting it to float */
+  if(UInt16_Input)
+    {
+      UInt16_Image_Data = (uint16_t *)malloc(Naxis1*Naxis2*sizeof(uint16_t));
+      if(UInt16_Image_Data == NULL)
+	{
+	  fprintf(stderr,"object_test: failed to allocate 16 bit memory (%d,%d).\n",Naxis1,Naxis2);
+	  fits_close_file(fits_fp,&status);
+	  return FALSE;
+	}
+      retval = fits_read_img(fits_fp,TUSHORT,1,Naxis1*Naxis2,NULL,UInt16_Image_Data,NULL,&status);
+      if(retval)
+	{
+	  fits_report_error(stderr,status);
+	  fits_close_file(fits_fp,&status);
+	  fprintf(stderr,"object_test:fits_read_img:Failed to read 16 bit FITS (%d,%d).\n",Naxis1,Naxis2);
+	  return FALSE;
+	}
+    }
 
 
   /* 
@@ -826,18 +1372,19 @@ static int Save(void)
 
 
 /**
- * Create an output object mask from pixel data in object list.
+ * Create an output object mask from the label map filled in by detection, with the centre of each object 
+ * in the object list highlighted.
  * @param object_list The objects to create.
  * @return TRUE on success, FALSE on failure.
  * @see #Naxis1
  * @see #Naxis2
  * @see #Object_Mask_Data
+ * @see #Label_Map_Data
  */
 static int Object_Mask_Create(Object *object_list)
 {
   Object *object = NULL;
-  HighPixel *high_pixel = NULL;
-  int x,y,objnum;
+  int i,x,y;
 
   Object_Mask_Data = (unsigned short*)malloc(Naxis1*Naxis2*sizeof(unsigned short));
   if(Object_Mask_Data == NULL)
@@ -845,22 +1392,11 @@ static int Object_Mask_Create(Object *object_list)
       fprintf(stderr,"Failed to allocate Object Mask(%d,%d).\n",Naxis1,Naxis2);
       return FALSE;
     }
+  for(i = 0; i < (Naxis1*Naxis2); i++)
+    Object_Mask_Data[i] = (Label_Map_Data[i] % 65536);
   object = object_list;
   while(object != NULL)
     {
-      objnum = object->objnum;
-      objnum = (objnum % 65536);
-      high_pixel = object->highpixel;
-      while(high_pixel != NULL)
-	{
-	  x = high_pixel->x;
-	  y = high_pixel->y;
-	  if((x > -1) &&(x < Naxis1)&&(y > -1) &&(y < Naxis2))
-	    Object_Mask_Data[(y*Naxis1)+x] = objnum;
-	  /* and to next pixel */
-	  high_pixel = high_pixel->next_pixel;
-	}
-
       /* highlight centre-point */
       x = (int)(object->xpos);
       y = (int)(object->ypos);
@@ -876,6 +1412,350 @@ static int Object_Mask_Create(Object *object_list)
 /* ---------------------------------------------------------------------------------------------- */
 
 
+/**
+ * Convert the object list to a column catalogue with Object_Catalogue_From_List, and check every column
+ * and pixel range against the list. Each object's pixels are walked from its highpixel list or span list,
+ * and must come back in order in [pixel_start,pixel_end), which must hold numpix pixels (or only the 
+ * Max_Pixel_Count stored, for oversized objects). Span pixel values are read back from the image, so this
+ * must be called before it is freed. Mismatches are reported, and the catalogue freed with 
+ * Object_Catalogue_Free.
+ * @param object_list The objects to check the catalogue against.
+ * @return TRUE if the catalogue matches the list, FALSE on a mismatch or failure.
+ * @see #Max_Pixel_Count
+ */
+static int Catalogue_Test(Object *object_list)
+{
+  Object_Catalogue catalogue;
+  Object *object = NULL;
+  HighPixel *pixel = NULL;
+  float value;
+  int i,p,s,x,y,pixel_count,index,mismatch_count;
+
+  if(!Object_Catalogue_From_List(object_list,&catalogue))
+    {
+      Object_Error();
+      return FALSE;
+    }
+  mismatch_count = 0;
+  i = 0;
+  for(object = object_list;object != NULL;object = object->nextobject)
+    {
+      if(i >= catalogue.object_count)
+	{
+	  fprintf(stderr,"object_test: catalogue has only %d objects.\n",catalogue.object_count);
+	  mismatch_count++;
+	  break;
+	}
+      if((catalogue.xpos[i] != object->xpos)||(catalogue.ypos[i] != object->ypos)||
+	 (catalogue.total[i] != object->total)||(catalogue.numpix[i] != object->numpix)||
+	 (catalogue.peak[i] != object->peak)||(catalogue.is_stellar[i] != object->is_stellar)||
+	 (catalogue.fwhmx[i] != object->fwhmx)||(catalogue.fwhmy[i] != object->fwhmy)||
+	 (catalogue.ellipticity[i] != object->ellipticity)||(catalogue.ellip_theta[i] != object->ellip_theta)||
+	 (catalogue.is_oversized[i] != object->is_oversized))
+	{
+	  fprintf(stderr,"object_test: catalogue object %d columns do not match object %d.\n",i,object->objnum);
+	  mismatch_count++;
+	}
+      pixel_count = object->numpix;
+      if(object->is_oversized && (Max_Pixel_Count > 0) && (Max_Pixel_Count < pixel_count))
+	pixel_count = Max_Pixel_Count;
+      if((catalogue.pixel_end[i]-catalogue.pixel_start[i]) != pixel_count)
+	{
+	  fprintf(stderr,"object_test: catalogue object %d has %d pixels, object %d should have %d.\n",i,
+		  catalogue.pixel_end[i]-catalogue.pixel_start[i],object->objnum,pixel_count);
+	  mismatch_count++;
+	}
+      /* walk the object's own pixels, in the order the catalogue copied them */
+      p = catalogue.pixel_start[i];
+      if(object->span_list != NULL)
+	{
+	  for(s = 0;s < object->span_count;s++)
+	    {
+	      y = object->span_list[s].y;
+	      for(x = object->span_list[s].x_start;(x <= object->span_list[s].x_end)&&(p < catalogue.pixel_end[i]);x++)
+		{
+		  index = (y*object->naxis1)+x;
+		  if(object->pixel_type == OBJECT_PIXEL_TYPE_UINT16)
+		    value = object->bzero+(object->bscale*(float)(((const uint16_t *)object->image)[index]));
+		  else if(object->pixel_type == OBJECT_PIXEL_TYPE_INT32)
+		    value = object->bzero+(object->bscale*(float)(((const int32_t *)object->image)[index]));
+		  else
+		    value = ((const float *)object->image)[index];
+		  value -= object->image_median;
+		  if((catalogue.pixel_x[p] != x)||(catalogue.pixel_y[p] != y)||(catalogue.pixel_value[p] != value))
+		    {
+		      fprintf(stderr,"object_test: catalogue pixel %d does not match object %d span pixel %d,%d.\n",
+			      p,object->objnum,x,y);
+		      mismatch_count++;
+		    }
+		  p++;
+		}
+	    }
+	}
+      else
+	{
+	  for(pixel = object->highpixel;(pixel != NULL)&&(p < catalogue.pixel_end[i]);pixel = pixel->next_pixel)
+	    {
+	      if((catalogue.pixel_x[p] != pixel->x)||(catalogue.pixel_y[p] != pixel->y)||
+		 (catalogue.pixel_value[p] != pixel->value))
+		{
+		  fprintf(stderr,"object_test: catalogue pixel %d does not match object %d pixel %d,%d.\n",
+			  p,object->objnum,pixel->x,pixel->y);
+		  mismatch_count++;
+		}
+	      p++;
+	    }
+	}
+      if(p != catalogue.pixel_end[i])
+	{
+	  fprintf(stderr,"object_test: object %d ran out of pixels at %d, before catalogue pixel_end %d.\n",
+		  object->objnum,p,catalogue.pixel_end[i]);
+	  mismatch_count++;
+	}
+      i++;
+    }
+  if(i != catalogue.object_count)
+    {
+      fprintf(stderr,"object_test: catalogue has %d objects, the list %d.\n",catalogue.object_count,i);
+      mismatch_count++;
+    }
+  fprintf(stdout,"object_test: Catalogue of %d objects and %d pixels checked against the list, %d mismatches.\n",
+	  catalogue.object_count,catalogue.pixel_count,mismatch_count);
+  if(!Object_Catalogue_Free(&catalogue))
+    {
+      Object_Error();
+      return FALSE;
+    }
+  return (mismatch_count == 0);
+}
+
+
+/* ---------------------------------------------------------------------------------------------- */
+
+
+/**
+ * Index the object list with Object_Index_Create, and check the index against a brute force scan of the
+ * list's xpos and ypos. For every object, the nearest other object (Object_Index_Nearest_Get excluding the
+ * object itself), and the objects within OBJECT_TEST_INDEX_RADIUS of it, and within a box of that half width
+ * around it, are found with the index, then again by scanning the whole list, and the two passes timed. The
+ * nearest distances must match (ties may pick either object), and the radius and box queries must find the 
+ * same objects, each once. Mismatches and both timings are reported, and the index freed with 
+ * Object_Index_Free.
+ * @param object_list The objects to index.
+ * @return TRUE if the index matches the brute force scan, FALSE on a mismatch or failure.
+ * @see #Index_Query_Struct
+ * @see #OBJECT_TEST_INDEX_RADIUS
+ * @see #difftimeus
+ */
+static int Index_Test(Object *object_list)
+{
+  struct timespec start_time,stop_time;
+  struct Index_Query_Struct *index_query_list = NULL;
+  struct Index_Query_Struct *scan_query_list = NULL;
+  Object_Index *index = NULL;
+  Object *object = NULL;
+  Object *other_object = NULL;
+  Object **result_list = NULL;
+  float dx,dy,distance_squared,nearest_distance_squared,x_start,y_start,x_end,y_end;
+  int i,j,k,object_count,result_count,index_us,scan_us,mismatch_count,retval;
+
+  object_count = 0;
+  for(object = object_list;object != NULL;object = object->nextobject)
+    object_count++;
+  if(object_count == 0)
+    {
+      fprintf(stdout,"object_test: No objects to index.\n");
+      return TRUE;
+    }
+  index_query_list = (struct Index_Query_Struct *)malloc(object_count*sizeof(struct Index_Query_Struct));
+  scan_query_list = (struct Index_Query_Struct *)malloc(object_count*sizeof(struct Index_Query_Struct));
+  result_list = (Object **)malloc(object_count*sizeof(Object *));
+  if((index_query_list == NULL)||(scan_query_list == NULL)||(result_list == NULL))
+    {
+      fprintf(stderr,"object_test: Failed to allocate index test lists for %d objects.\n",object_count);
+      if(index_query_list != NULL)
+	free(index_query_list);
+      if(scan_query_list != NULL)
+	free(scan_query_list);
+      if(result_list != NULL)
+	free(result_list);
+      return FALSE;
+    }
+  /* query around every object with the index, creating it inside the timing */
+  retval = TRUE;
+  clock_gettime(CLOCK_REALTIME,&start_time);
+  if(!Object_Index_Create(object_list,0.0f,&index))
+    {
+      Object_Error();
+      retval = FALSE;
+    }
+  i = 0;
+  for(object = object_list;(object != NULL)&&retval;object = object->nextobject)
+    {
+      x_start = object->xpos-OBJECT_TEST_INDEX_RADIUS;
+      y_start = object->ypos-OBJECT_TEST_INDEX_RADIUS;
+      x_end = object->xpos+OBJECT_TEST_INDEX_RADIUS;
+      y_end = object->ypos+OBJECT_TEST_INDEX_RADIUS;
+      if((!Object_Index_Nearest_Get(index,object->xpos,object->ypos,object,&(index_query_list[i].nearest_object),
+				    &(index_query_list[i].nearest_distance)))||
+	 (!Object_Index_Radius_Get(index,object->xpos,object->ypos,OBJECT_TEST_INDEX_RADIUS,result_list,0,
+				   &(index_query_list[i].radius_count)))||
+	 (!Object_Index_Box_Get(index,x_start,y_start,x_end,y_end,result_list,0,&(index_query_list[i].box_count))))
+	{
+	  Object_Error();
+	  retval = FALSE;
+	}
+      i++;
+    }
+  clock_gettime(CLOCK_REALTIME,&stop_time);
+  index_us = difftimeus(start_time,stop_time);
+  /* query around every object by scanning the whole list, with the same float arithmetic as the index */
+  clock_gettime(CLOCK_REALTIME,&start_time);
+  i = 0;
+  for(object = object_list;(object != NULL)&&retval;object = object->nextobject)
+    {
+      x_start = object->xpos-OBJECT_TEST_INDEX_RADIUS;
+      y_start = object->ypos-OBJECT_TEST_INDEX_RADIUS;
+      x_end = object->xpos+OBJECT_TEST_INDEX_RADIUS;
+      y_end = object->ypos+OBJECT_TEST_INDEX_RADIUS;
+      scan_query_list[i].nearest_object = NULL;
+      nearest_distance_squared = 0.0f;
+      scan_query_list[i].radius_count = 0;
+      scan_query_list[i].box_count = 0;
+      for(other_object = object_list;other_object != NULL;other_object = other_object->nextobject)
+	{
+	  dx = other_object->xpos-object->xpos;
+	  dy = other_object->ypos-object->ypos;
+	  distance_squared = (dx*dx)+(dy*dy);
+	  if((other_object != object)&&((scan_query_list[i].nearest_object == NULL)||
+					(distance_squared < nearest_distance_squared)))
+	    {
+	      scan_query_list[i].nearest_object = other_object;
+	      nearest_distance_squared = distance_squared;
+	    }
+	  if(distance_squared <= (OBJECT_TEST_INDEX_RADIUS*OBJECT_TEST_INDEX_RADIUS))
+	    scan_query_list[i].radius_count++;
+	  if((other_object->xpos >= x_start)&&(other_object->xpos <= x_end)&&
+	     (other_object->ypos >= y_start)&&(other_object->ypos <= y_end))
+	    scan_query_list[i].box_count++;
+	}
+      scan_query_list[i].nearest_distance = sqrt(nearest_distance_squared);
+      i++;
+    }
+  clock_gettime(CLOCK_REALTIME,&stop_time);
+  scan_us = difftimeus(start_time,stop_time);
+  /* compare the two passes, then check each object the radius and box queries found is inside and found once */
+  mismatch_count = 0;
+  i = 0;
+  for(object = object_list;(object != NULL)&&retval;object = object->nextobject)
+    {
+      if((index_query_list[i].nearest_object == NULL) != (scan_query_list[i].nearest_object == NULL))
+	{
+	  fprintf(stderr,"object_test: Only one of the index and the scan found an object nearest object %d.\n",
+		  object->objnum);
+	  mismatch_count++;
+	}
+      else if((index_query_list[i].nearest_object != NULL)&&
+	      (index_query_list[i].nearest_distance != scan_query_list[i].nearest_distance))
+	{
+	  fprintf(stderr,"object_test: Index found object %d nearest object %d at %.4f pixels, "
+		  "the scan object %d at %.4f pixels.\n",index_query_list[i].nearest_object->objnum,
+		  object->objnum,index_query_list[i].nearest_distance,scan_query_list[i].nearest_object->objnum,
+		  scan_query_list[i].nearest_distance);
+	  mismatch_count++;
+	}
+      if(index_query_list[i].radius_count != scan_query_list[i].radius_count)
+	{
+	  fprintf(stderr,"object_test: Index found %d objects within %.2f pixels of object %d, the scan %d.\n",
+		  index_query_list[i].radius_count,OBJECT_TEST_INDEX_RADIUS,object->objnum,
+		  scan_query_list[i].radius_count);
+	  mismatch_count++;
+	}
+      if(index_query_list[i].box_count != scan_query_list[i].box_count)
+	{
+	  fprintf(stderr,"object_test: Index found %d objects in the box around object %d, the scan %d.\n",
+		  index_query_list[i].box_count,object->objnum,scan_query_list[i].box_count);
+	  mismatch_count++;
+	}
+      if(!Object_Index_Radius_Get(index,object->xpos,object->ypos,OBJECT_TEST_INDEX_RADIUS,result_list,
+				  object_count,&result_count))
+	{
+	  Object_Error();
+	  retval = FALSE;
+	  break;
+	}
+      for(j = 0;j < result_count;j++)
+	{
+	  dx = result_list[j]->xpos-object->xpos;
+	  dy = result_list[j]->ypos-object->ypos;
+	  if(((dx*dx)+(dy*dy)) > (OBJECT_TEST_INDEX_RADIUS*OBJECT_TEST_INDEX_RADIUS))
+	    {
+	      fprintf(stderr,"object_test: Index found object %d outside %.2f pixels of object %d.\n",
+		      result_list[j]->objnum,OBJECT_TEST_INDEX_RADIUS,object->objnum);
+	      mismatch_count++;
+	    }
+	  for(k = 0;k < j;k++)
+	    {
+	      if(result_list[k] == result_list[j])
+		{
+		  fprintf(stderr,"object_test: Index found object %d twice within %.2f pixels of object %d.\n",
+			  result_list[j]->objnum,OBJECT_TEST_INDEX_RADIUS,object->objnum);
+		  mismatch_count++;
+		}
+	    }
+	}
+      x_start = object->xpos-OBJECT_TEST_INDEX_RADIUS;
+      y_start = object->ypos-OBJECT_TEST_INDEX_RADIUS;
+      x_end = object->xpos+OBJECT_TEST_INDEX_RADIUS;
+      y_end = object->ypos+OBJECT_TEST_INDEX_RADIUS;
+      if(!Object_Index_Box_Get(index,x_start,y_start,x_end,y_end,result_list,object_count,&result_count))
+	{
+	  Object_Error();
+	  retval = FALSE;
+	  break;
+	}
+      for(j = 0;j < result_count;j++)
+	{
+	  if((result_list[j]->xpos < x_start)||(result_list[j]->xpos > x_end)||
+	     (result_list[j]->ypos < y_start)||(result_list[j]->ypos > y_end))
+	    {
+	      fprintf(stderr,"object_test: Index found object %d outside the box around object %d.\n",
+		      result_list[j]->objnum,object->objnum);
+	      mismatch_count++;
+	    }
+	  for(k = 0;k < j;k++)
+	    {
+	      if(result_list[k] == result_list[j])
+		{
+		  fprintf(stderr,"object_test: Index found object %d twice in the box around object %d.\n",
+			  result_list[j]->objnum,object->objnum);
+		  mismatch_count++;
+		}
+	    }
+	}
+      i++;
+    }
+  if(retval)
+    {
+      fprintf(stdout,"object_test: Index of %d objects checked against a brute force scan, %d mismatches.\n",
+	      object_count,mismatch_count);
+      fprintf(stdout,"object_test: The index took %d us, the brute force scan %d us.\n",index_us,scan_us);
+    }
+  if((index != NULL)&&(!Object_Index_Free(&index)))
+    {
+      Object_Error();
+      retval = FALSE;
+    }
+  free(index_query_list);
+  free(scan_query_list);
+  free(result_list);
+  return (retval && (mismatch_count == 0));
+}
+
+
+/* ---------------------------------------------------------------------------------------------- */
+
+
 /**
  * Routine to calculate the difference between start_time and stop_time, and to return 
  * the number of milliseconds difference.
@@ -901,6 +1781,30 @@ static int difftimems(struct timespec start_time,struct timespec stop_time)
   return ms;
 }
 
+/**
+ * Routine to calculate the difference between start_time and stop_time, and to return 
+ * the number of microseconds difference.
+ * @param start_time The start time.
+ * @param stop_time The end time.
+ * @return The number of microseconds between start_time and stop_time.
+ * @see #ONE_SECOND_NS
+ * @see #OBJECT_TEST_ONE_MICROSECOND_NS
+ */
+static int difftimeus(struct timespec start_time,struct timespec stop_time)
+{
+  int sec,ns,us;
+
+  sec = stop_time.tv_sec-start_time.tv_sec;
+  ns = stop_time.tv_nsec-start_time.tv_nsec;
+  if(ns < 0)
+    {
+      ns += ONE_SECOND_NS;
+      sec -= 1;
+    }
+  us = (sec*(ONE_SECOND_NS/OBJECT_TEST_ONE_MICROSECOND_NS))+(ns/OBJECT_TEST_ONE_MICROSECOND_NS);
+  return us;
+}
+
 /*
 ** $Log: not supported by cvs2svn $
 ** Revision 1.8  2009/01/30 15:22:55  cjm
@@ -76,6 +76,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <strings.h>
 #include <time.h>
 #include <math.h>
@@ -124,6 +125,7 @@ static float BGSigma = 10.0;                               /* Default threshold
 static int BGSigma_Set_Flag = FALSE;                       /* Flag to say if BGSigma specified in args */
 static int Log_Level = 0;                                  /* Log level */
 static int verbose = FALSE;                                /* Verbose flag (off by default) */
+static float Moffat_Bin_Width = 0.0;                       /* Moffat fit annulus width, 0 for unbinned */
 static int fltcmp(const void *v1, const void *v2);
 
 /* ------------------------------------------------------- */
@@ -136,9 +138,13 @@ int main(int argc, char *argv[])
 {
   Object *object_list = NULL;
   Object *object = NULL;
+  Object *unbinned_object_list = NULL;
+  Object *unbinned_object = NULL;
+  float *unbinned_image_data = NULL;
   struct timespec start_time,stop_time;
-  int seeing_flag;
-  float seeing,thresh;
+  int seeing_flag,unbinned_seeing_flag;
+  float seeing,thresh,unbinned_seeing;
+  float fwhm_difference,max_fwhm_difference;
   int obj_count_init;                   /* initial count of all objects */
   int obj_count_size;                   /* objects bigger than size limit (currently 8 pixels) */
   int obj_count_stellar;                /* objects with ellipticity below limit */
@@ -213,6 +219,26 @@ int main(int argc, char *argv[])
 	      Median, BGSigma, Background_SD, thresh);
   }
 
+  /*
+    -----------------
+    MOFFAT FIT BINNING
+    -----------------
+    Object_List_Get is destructive, so keep a copy of the image
+    to detect again with the unbinned fit, for comparison.
+  */
+  if (Moffat_Bin_Width > 0.0){
+    if(!Object_Moffat_Bin_Width_Set(Moffat_Bin_Width)){
+      Object_Error();
+      return 4;
+    }
+    unbinned_image_data = (float *)malloc(Naxis1*Naxis2*sizeof(float));
+    if(unbinned_image_data == NULL){
+      fprintf(stderr,"object_test: failed to allocate image copy (%d,%d).\n",Naxis1,Naxis2);
+      return 4;
+    }
+    memcpy(unbinned_image_data,Image_Data,Naxis1*Naxis2*sizeof(float));
+  }
+
   /*
     -------------
     OBJECT DETECT
@@ -229,6 +255,40 @@ int main(int argc, char *argv[])
     return 4;
   }
 
+  /* compare the binned Moffat fit with the unbinned fit
+     --------------------------------------------------- */
+  if (Moffat_Bin_Width > 0.0){
+    Object_Moffat_Bin_Width_Set(0.0);
+    retval = Object_List_Get(unbinned_image_data,Median,Naxis1,Naxis2,thresh,8,&unbinned_object_list,
+			     &unbinned_seeing_flag,&unbinned_seeing,
+			     &obj_count_init,&obj_count_size,&obj_count_stellar,&obj_count_dia);
+    free(unbinned_image_data);
+    if(retval == FALSE){
+      Object_Error();
+      return 4;
+    }
+    /* both detections find the same objects, so compare the stellar ones in turn */
+    max_fwhm_difference = 0.0;
+    object = object_list;
+    unbinned_object = unbinned_object_list;
+    while((object != NULL)&&(unbinned_object != NULL)){
+      if (object->is_stellar){
+	fwhm_difference = fabs(object->fwhmx-unbinned_object->fwhmx);
+	if (fwhm_difference > max_fwhm_difference)
+	  max_fwhm_difference = fwhm_difference;
+      }
+      object = object->nextobject;
+      unbinned_object = unbinned_object->nextobject;
+    }
+    fprintf(stdout,"object_test: Moffat fit in %.2f pixel annuli: seeing %.4f pixels (seeing_flag = %d), "
+	    "unbinned: seeing %.4f pixels (seeing_flag = %d), a difference of %.4f pixels (%.4f arcsec).\n",
+	    Moffat_Bin_Width,seeing,seeing_flag,unbinned_seeing,unbinned_seeing_flag,seeing-unbinned_seeing,
+	    (seeing-unbinned_seeing)*PixelScale);
+    fprintf(stdout,"object_test: The largest difference in a stellar object's FWHM was %.4f pixels.\n",
+	    max_fwhm_difference);
+    Object_List_Free(&unbinned_object_list);
+  }
+
   /* print out time taken & column headers for results
      ------------------------------------------------- */
   if (verbose){
@@ -429,6 +489,25 @@ static int Parse_Args(int argc,char *argv[])
       }
     }
 
+    /* ------------------------ */
+    /* MOFFAT FIT ANNULUS WIDTH */
+    /* ------------------------ */
+    
+    else if (strcmp(argv[i],"-moffat_bin")==0){
+      if((i+1) < argc){
+	retval = sscanf(argv[i+1],"%f",&Moffat_Bin_Width);
+	if(retval != 1){
+	  fprintf(stderr,"object_test: Parse_Args: moffat_bin parameter %s not a float.\n",argv[i+1]);
+	  return FALSE;
+	}
+	i++;
+      }
+      else {
+	fprintf(stderr,"object_test: Parse_Args: moffat_bin parameter missing.\n");
+	return FALSE;
+      }
+    }
+
     /* --------------- */
     /* INPUT FITS FILE */
     /* --------------- */
@@ -471,7 +550,7 @@ static void Help(void)
 {
   fprintf(stdout,"object_test: Tests the object finding routine in libdprt_object.\n");
   fprintf(stdout,"object_test [-h[elp]] [-v[erbose]] [-l[og_level] <level>]\n");
-  fprintf(stdout,"\t[-t[hreshold] <counts>] [-s[igma] <sigma>]\n");  
+  fprintf(stdout,"\t[-t[hreshold] <counts>] [-s[igma] <sigma>] [-moffat_bin <pixels>]\n");  
   fprintf(stdout,"\t<FITS filename>  [-o[utput] <FITS filename>]\n");
   fprintf(stdout,"-help prints this help message and exits.\n");
   fprintf(stdout,"-verbose prints progress to stdout (default off).\n");
@@ -479,6 +558,8 @@ static void Help(void)
   fprintf(stdout,"-threshold sets the threshold level in counts\n");
   fprintf(stdout,"-sigma sets the threshold level in sigma (default 10.0)\n");
   fprintf(stdout,"-output writes an object mask to the specified FITS filename.\n");
+  fprintf(stdout,"-moffat_bin fits the Moffat profile in annuli this many pixels wide, and reports\n"
+	  "\tthe difference this makes to the seeing, compared with the unbinned fit.\n");
   fprintf(stdout,"You must always specify a filename to reduce.\n");
   fprintf(stdout,"Ideally, pass in a flat-fielded de-biased image.\n");
 }